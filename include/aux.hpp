@@ -27,5 +27,7 @@ std::vector<cv::Vec3f> findCircles(cv::Mat img, bool isMask = true);
 std::vector<cv::Vec4i> findLines(cv::Mat img, bool isMask = true);
 cv::Point getVanishingPoint(cv::Mat img, std::vector<cv::Vec4i> lines);
 double getAngleWithVertical(double m);
+double getRegionDensity(cv::Mat integral, cv::Rect region);
+double getOtsuMask(cv::Mat bgr, cv::Mat *gray, cv::Mat *mask);
 
 #endif
\ No newline at end of file
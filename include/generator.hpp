@@ -0,0 +1,43 @@
+/*=============================================================================
+#  Author:           Nicolas Queiroga - https://github.com/NicolasQueiroga/
+#  Email:            n.macielqueiroga@gmail.com
+#  FileName:         generator.hpp
+#  Description:      This file contais prototype info for generator.cpp
+#  Version:          0.0.1
+=============================================================================*/
+
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include <string>
+#include <vector>
+#include <random>
+
+#define HARD_MAX_NODES 20
+
+enum Difficulty
+{
+    EASY,   // naked singles only
+    MEDIUM, // naked and hidden singles
+    HARD,   // needs search, at most HARD_MAX_NODES guesses
+    EXPERT, // needs deeper search
+    DIFFICULTY_COUNT
+};
+
+struct Puzzle
+{
+    int board[9][9];
+    int clues;
+    long nodes;
+    Difficulty difficulty;
+    double seconds; // generation and grading time, measured in the worker
+};
+
+/* Function Deffinitions */
+void generateFullBoard(int board[9][9], std::mt19937 &rng);
+Difficulty gradeBoard(const int board[9][9], long *nodes = nullptr);
+Puzzle generatePuzzle(std::mt19937 &rng);
+std::vector<Puzzle> generatePuzzles(int count, unsigned int seed, int threads = 0);
+const char *difficultyName(Difficulty difficulty);
+
+#endif
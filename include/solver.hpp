@@ -0,0 +1,29 @@
+/*=============================================================================
+#  Author:           Nicolas Queiroga - https://github.com/NicolasQueiroga/
+#  Email:            n.macielqueiroga@gmail.com
+#  FileName:         solver.hpp
+#  Description:      This file contais prototype info for solver.cpp
+#  Version:          0.0.1
+=============================================================================*/
+
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+
+#include <string>
+
+/* Boards are int[9][9] indexed [row][col], 0 marks an empty cell, the same
+   layout as SudokuProc::board. The 81-char format lists the rows top to
+   bottom with '.' for empty cells. */
+
+struct SolverStats
+{
+    long nodes = 0; // guesses made by the search
+};
+
+/* Function Deffinitions */
+int countSolutions(const int board[9][9], int limit = 2, int solution[9][9] = nullptr, SolverStats *stats = nullptr, bool hiddenSingles = true);
+bool solveBoard(int board[9][9]);
+bool hasUniqueSolution(const int board[9][9]);
+std::string boardToString(const int board[9][9]);
+
+#endif
@@ -7,11 +7,16 @@
 =============================================================================*/
 
 #include "aux.hpp"
+#include <opencv2/core/hal/intrin.hpp>
 #include <iostream>
 #include <vector>
+#include <array>
 #include <string>
+#include <cfloat>
 #include <math.h>
 
+#define STRIP_BYTES (64 * 1024)
+
 std::vector<int> colorPicker(std::string path)
 {
     cv::Mat bgr, hsv, mask;
@@ -241,3 +246,134 @@ double getAngleWithVertical(double m)
     double rads = CV_PI / 2 + atan(m);
     return rads /**180/CV_PI*/;
 }
+
+double getRegionDensity(cv::Mat integral, cv::Rect region)
+{
+    // integral is the CV_32S output of cv::integral on a 0/255 mask, so any
+    // rectangle sum is four lookups regardless of its size
+    region &= cv::Rect(0, 0, integral.cols - 1, integral.rows - 1);
+    if (region.area() <= 0)
+        return 0;
+
+    int x0 = region.x, y0 = region.y;
+    int x1 = region.x + region.width, y1 = region.y + region.height;
+    double sum = integral.at<int>(y1, x1) - integral.at<int>(y0, x1) - integral.at<int>(y1, x0) + integral.at<int>(y0, x0);
+
+    return sum / (255.0 * region.area());
+}
+
+static void bgrRowToGray(const uchar *bgr, uchar *gray, int width, int *hist)
+{
+    // 8-bit fixed point BT.601 weights (29 + 150 + 77 = 256), at most 1 off cv::cvtColor
+    int x = 0;
+#if CV_SIMD
+    cv::v_uint16 wb = cv::vx_setall_u16(29), wg = cv::vx_setall_u16(150), wr = cv::vx_setall_u16(77);
+    cv::v_uint16 half = cv::vx_setall_u16(128);
+    for (; x <= width - CV_SIMD_WIDTH; x += CV_SIMD_WIDTH)
+    {
+        cv::v_uint8 b, g, r;
+        cv::v_uint16 b0, b1, g0, g1, r0, r1;
+        cv::v_load_deinterleave(bgr + 3 * x, b, g, r);
+        cv::v_expand(b, b0, b1);
+        cv::v_expand(g, g0, g1);
+        cv::v_expand(r, r0, r1);
+
+        cv::v_uint16 y0 = cv::v_add_wrap(cv::v_add_wrap(cv::v_mul_wrap(b0, wb), cv::v_mul_wrap(g0, wg)), cv::v_add_wrap(cv::v_mul_wrap(r0, wr), half));
+        cv::v_uint16 y1 = cv::v_add_wrap(cv::v_add_wrap(cv::v_mul_wrap(b1, wb), cv::v_mul_wrap(g1, wg)), cv::v_add_wrap(cv::v_mul_wrap(r1, wr), half));
+        cv::v_store(gray + x, cv::v_pack(cv::v_shr<8>(y0), cv::v_shr<8>(y1)));
+    }
+#endif
+    for (; x < width; x++)
+        gray[x] = (uchar)((bgr[3 * x] * 29 + bgr[3 * x + 1] * 150 + bgr[3 * x + 2] * 77 + 128) >> 8);
+
+    // the row is still in L1, so the histogram costs no extra trip to memory
+    for (x = 0; x < width; x++)
+        hist[gray[x]]++;
+}
+
+static void thresholdRowInv(const uchar *gray, uchar *mask, int width, uchar thresh)
+{
+    int x = 0;
+#if CV_SIMD
+    cv::v_uint8 t = cv::vx_setall_u8(thresh);
+    for (; x <= width - CV_SIMD_WIDTH; x += CV_SIMD_WIDTH)
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 9)
+        cv::v_store(mask + x, cv::v_le(cv::vx_load(gray + x), t));
+#else
+        cv::v_store(mask + x, cv::vx_load(gray + x) <= t);
+#endif
+#endif
+    for (; x < width; x++)
+        mask[x] = gray[x] > thresh ? 0 : 255;
+}
+
+static int getOtsuThreshold(const int *hist, int total)
+{
+    // same search as cv::threshold with THRESH_OTSU
+    double scale = 1. / total, mu = 0;
+    for (int i = 0; i < 256; i++)
+        mu += i * (double)hist[i];
+    mu *= scale;
+
+    double mu1 = 0, q1 = 0, maxSigma = 0;
+    int thresh = 0;
+    for (int i = 0; i < 256; i++)
+    {
+        double p_i = hist[i] * scale;
+        mu1 *= q1;
+        q1 += p_i;
+        double q2 = 1. - q1;
+
+        if (std::min(q1, q2) < FLT_EPSILON || std::max(q1, q2) > 1. - FLT_EPSILON)
+            continue;
+
+        mu1 = (mu1 + i * p_i) / q1;
+        double mu2 = (mu - q1 * mu1) / q2;
+        double sigma = q1 * q2 * (mu1 - mu2) * (mu1 - mu2);
+        if (sigma > maxSigma)
+        {
+            maxSigma = sigma;
+            thresh = i;
+        }
+    }
+
+    return thresh;
+}
+
+double getOtsuMask(cv::Mat bgr, cv::Mat *gray, cv::Mat *mask)
+{
+    // Equivalent to cvtColor(BGR2GRAY) + threshold(OTSU | BINARY_INV) in two
+    // passes over strips sized to stay in cache; gray and mask are reused
+    // between calls when the frame size does not change
+    CV_Assert(bgr.type() == CV_8UC3);
+    gray->create(bgr.size(), CV_8UC1);
+    mask->create(bgr.size(), CV_8UC1);
+
+    int stripRows = std::max(1, STRIP_BYTES / (4 * bgr.cols));
+    int strips = (bgr.rows + stripRows - 1) / stripRows;
+    std::vector<std::array<int, 256>> hists(strips);
+
+    cv::parallel_for_(cv::Range(0, strips), [&](const cv::Range &range) {
+        for (int s = range.start; s < range.end; s++)
+        {
+            int *hist = hists[s].data();
+            std::fill(hist, hist + 256, 0);
+            for (int y = s * stripRows; y < std::min((s + 1) * stripRows, bgr.rows); y++)
+                bgrRowToGray(bgr.ptr<uchar>(y), gray->ptr<uchar>(y), bgr.cols, hist);
+        }
+    });
+
+    int hist[256] = {0};
+    for (const std::array<int, 256> &h : hists)
+        for (int i = 0; i < 256; i++)
+            hist[i] += h[i];
+    int thresh = getOtsuThreshold(hist, bgr.rows * bgr.cols);
+
+    cv::parallel_for_(cv::Range(0, strips), [&](const cv::Range &range) {
+        for (int s = range.start; s < range.end; s++)
+            for (int y = s * stripRows; y < std::min((s + 1) * stripRows, bgr.rows); y++)
+                thresholdRowInv(gray->ptr<uchar>(y), mask->ptr<uchar>(y), bgr.cols, (uchar)thresh);
+    });
+
+    return thresh;
+}
@@ -0,0 +1,121 @@
+/*=============================================================================
+#  Author:           Nicolas Queiroga - https://github.com/NicolasQueiroga/
+#  Email:            n.macielqueiroga@gmail.com
+#  FileName:         generator.cpp
+#  Description:      unique-solution puzzle generator with difficulty grading
+#  Version:          0.0.1
+=============================================================================*/
+
+#include "generator.hpp"
+#include "solver.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
+
+static bool fillBoard(int board[9][9], int cell, std::mt19937 &rng)
+{
+    if (cell == 81)
+        return true;
+
+    int i = cell / 9, j = cell % 9;
+    int digits[9];
+    std::iota(digits, digits + 9, 1);
+    std::shuffle(digits, digits + 9, rng);
+
+    for (int digit : digits)
+    {
+        bool free = true;
+        for (int k = 0; k < 9 && free; k++)
+            free = board[i][k] != digit && board[k][j] != digit && board[i / 3 * 3 + k / 3][j / 3 * 3 + k % 3] != digit;
+        if (!free)
+            continue;
+
+        board[i][j] = digit;
+        if (fillBoard(board, cell + 1, rng))
+            return true;
+    }
+    board[i][j] = 0;
+    return false;
+}
+
+void generateFullBoard(int board[9][9], std::mt19937 &rng)
+{
+    std::fill(&board[0][0], &board[0][0] + 81, 0);
+    fillBoard(board, 0, rng);
+}
+
+Difficulty gradeBoard(const int board[9][9], long *nodes)
+{
+    SolverStats stats;
+    countSolutions(board, 2, nullptr, &stats);
+    if (nodes)
+        *nodes = stats.nodes;
+
+    if (stats.nodes > 0)
+        return stats.nodes <= HARD_MAX_NODES ? HARD : EXPERT;
+
+    // solved without guessing, check whether hidden singles were needed
+    SolverStats naked;
+    countSolutions(board, 1, nullptr, &naked, false);
+    return naked.nodes == 0 ? EASY : MEDIUM;
+}
+
+Puzzle generatePuzzle(std::mt19937 &rng)
+{
+    auto start = std::chrono::steady_clock::now();
+    Puzzle puzzle;
+    generateFullBoard(puzzle.board, rng);
+
+    // drop clues in random order, keeping each one whose removal breaks uniqueness
+    int order[81];
+    std::iota(order, order + 81, 0);
+    std::shuffle(order, order + 81, rng);
+
+    puzzle.clues = 81;
+    for (int cell : order)
+    {
+        int &clue = puzzle.board[cell / 9][cell % 9];
+        int digit = clue;
+        clue = 0;
+        if (hasUniqueSolution(puzzle.board))
+            puzzle.clues--;
+        else
+            clue = digit;
+    }
+
+    puzzle.difficulty = gradeBoard(puzzle.board, &puzzle.nodes);
+    puzzle.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return puzzle;
+}
+
+std::vector<Puzzle> generatePuzzles(int count, unsigned int seed, int threads)
+{
+    // puzzle k always comes from seed + k, so the output does not depend on threads
+    std::vector<Puzzle> puzzles(count);
+    std::atomic<int> next(0);
+
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back([&]() {
+            for (int k = next++; k < count; k = next++)
+            {
+                std::mt19937 rng(seed + k);
+                puzzles[k] = generatePuzzle(rng);
+            }
+        });
+    for (std::thread &worker : workers)
+        worker.join();
+
+    return puzzles;
+}
+
+const char *difficultyName(Difficulty difficulty)
+{
+    static const char *names[DIFFICULTY_COUNT] = {"easy", "medium", "hard", "expert"};
+    return names[difficulty];
+}
@@ -0,0 +1,221 @@
+/*=============================================================================
+#  Author:           Nicolas Queiroga - https://github.com/NicolasQueiroga/
+#  Email:            n.macielqueiroga@gmail.com
+#  FileName:         solver.cpp
+#  Description:      bitmask sudoku solver with early-exit solution counting
+#  Version:          0.0.1
+=============================================================================*/
+
+#include "solver.hpp"
+#include <bit>
+#include <cstdint>
+
+#define ALL_DIGITS 0x1FF
+
+struct SolverState
+{
+    uint8_t cells[81];
+    uint16_t rows[9], cols[9], boxes[9]; // digits already placed, bit d - 1 for digit d
+    int empty;
+};
+
+struct SearchContext
+{
+    int limit;
+    int found;
+    int *solution;
+    SolverStats *stats;
+    bool hiddenSingles;
+};
+
+struct UnitTable
+{
+    int cells[27][9]; // rows, then columns, then boxes
+};
+
+static constexpr UnitTable makeUnits()
+{
+    UnitTable units = {};
+    for (int i = 0; i < 9; i++)
+        for (int j = 0; j < 9; j++)
+        {
+            units.cells[i][j] = i * 9 + j;
+            units.cells[9 + i][j] = j * 9 + i;
+            units.cells[18 + i][j] = (i / 3 * 3 + j / 3) * 9 + i % 3 * 3 + j % 3;
+        }
+    return units;
+}
+
+static constexpr UnitTable units = makeUnits();
+
+static inline int boxOf(int cell)
+{
+    return cell / 27 * 3 + cell % 9 / 3;
+}
+
+static inline uint16_t candidates(const SolverState &s, int cell)
+{
+    return ~(s.rows[cell / 9] | s.cols[cell % 9] | s.boxes[boxOf(cell)]) & ALL_DIGITS;
+}
+
+static inline void place(SolverState &s, int cell, int digit)
+{
+    uint16_t bit = 1 << (digit - 1);
+    s.cells[cell] = digit;
+    s.rows[cell / 9] |= bit;
+    s.cols[cell % 9] |= bit;
+    s.boxes[boxOf(cell)] |= bit;
+    s.empty--;
+}
+
+static inline int digitOf(uint16_t bit)
+{
+    return std::countr_zero(bit) + 1;
+}
+
+// Places naked singles and, when enabled, hidden singles until neither
+// applies. Returns false on a contradiction.
+static bool propagate(SolverState &s, SearchContext &ctx)
+{
+    bool changed = true;
+    while (changed && s.empty > 0)
+    {
+        changed = false;
+        for (int cell = 0; cell < 81; cell++)
+        {
+            if (s.cells[cell])
+                continue;
+            uint16_t cand = candidates(s, cell);
+            if (!cand)
+                return false;
+            if (!(cand & (cand - 1)))
+            {
+                place(s, cell, digitOf(cand));
+                changed = true;
+            }
+        }
+
+        if (!ctx.hiddenSingles || changed)
+            continue;
+
+        for (int u = 0; u < 27; u++)
+        {
+            uint16_t once = 0, twice = 0, placed = 0;
+            for (int cell : units.cells[u])
+            {
+                if (s.cells[cell])
+                {
+                    placed |= 1 << (s.cells[cell] - 1);
+                    continue;
+                }
+                uint16_t cand = candidates(s, cell);
+                twice |= once & cand;
+                once |= cand;
+            }
+            if ((once | placed) != ALL_DIGITS)
+                return false;
+
+            uint16_t single = once & ~twice;
+            if (!single)
+                continue;
+            for (int cell : units.cells[u])
+            {
+                if (s.cells[cell])
+                    continue;
+                uint16_t cand = candidates(s, cell) & single;
+                if (!cand)
+                    continue;
+                if (cand & (cand - 1))
+                    return false; // two digits forced into one cell
+                place(s, cell, digitOf(cand));
+                single &= ~cand;
+            }
+            changed = true;
+        }
+    }
+
+    return true;
+}
+
+static void search(SolverState &s, SearchContext &ctx)
+{
+    if (!propagate(s, ctx))
+        return;
+
+    if (s.empty == 0)
+    {
+        if (ctx.found++ == 0 && ctx.solution)
+            for (int cell = 0; cell < 81; cell++)
+                ctx.solution[cell] = s.cells[cell];
+        return;
+    }
+
+    // branch on the cell with the fewest candidates
+    int best = -1, bestCount = 10;
+    uint16_t bestCand = 0;
+    for (int cell = 0; cell < 81 && bestCount > 2; cell++)
+    {
+        if (s.cells[cell])
+            continue;
+        uint16_t cand = candidates(s, cell);
+        int count = std::popcount(cand);
+        if (count < bestCount)
+        {
+            best = cell;
+            bestCount = count;
+            bestCand = cand;
+        }
+    }
+
+    while (bestCand && ctx.found < ctx.limit)
+    {
+        uint16_t bit = bestCand & -bestCand;
+        bestCand &= ~bit;
+
+        SolverState next = s;
+        place(next, best, digitOf(bit));
+        if (ctx.stats)
+            ctx.stats->nodes++;
+        search(next, ctx);
+    }
+}
+
+int countSolutions(const int board[9][9], int limit, int solution[9][9], SolverStats *stats, bool hiddenSingles)
+{
+    SolverState s = {};
+    s.empty = 81;
+    for (int i = 0; i < 9; i++)
+        for (int j = 0; j < 9; j++)
+        {
+            int digit = board[i][j];
+            if (digit == 0)
+                continue;
+            if (digit < 1 || digit > 9 || !(candidates(s, i * 9 + j) & (1 << (digit - 1))))
+                return 0;
+            place(s, i * 9 + j, digit);
+        }
+
+    SearchContext ctx = {limit, 0, solution ? &solution[0][0] : nullptr, stats, hiddenSingles};
+    search(s, ctx);
+    return ctx.found;
+}
+
+bool solveBoard(int board[9][9])
+{
+    return countSolutions(board, 1, board) == 1;
+}
+
+bool hasUniqueSolution(const int board[9][9])
+{
+    return countSolutions(board, 2) == 1;
+}
+
+std::string boardToString(const int board[9][9])
+{
+    std::string str(81, '.');
+    for (int i = 0; i < 9; i++)
+        for (int j = 0; j < 9; j++)
+            if (board[i][j] > 0)
+                str[i * 9 + j] = '0' + board[i][j];
+    return str;
+}
@@ -0,0 +1,61 @@
+/*=============================================================================
+#  Author:           Nicolas Queiroga - https://github.com/NicolasQueiroga/
+#  Email:            n.macielqueiroga@gmail.com
+#  FileName:         bench.cpp
+#  Description:      Benchmarks getOtsuMask against the OpenCV call chain
+#  Version:          0.0.1
+=============================================================================*/
+
+#include <iostream>
+#include "aux.hpp"
+
+#define ITERATIONS 200
+
+// the chain SudokuProc::preProcessFrame runs
+double chainMask(cv::Mat bgr, cv::Mat *gray, cv::Mat *dilated)
+{
+    cv::cvtColor(bgr, *gray, cv::COLOR_BGR2GRAY);
+    return cv::threshold(*gray, *dilated, 0, 255, cv::THRESH_OTSU | cv::THRESH_BINARY_INV);
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> paths = {"../img/sudoku.png", "../img/sudoku2.jpeg", "../img/sudoku3.jpeg", "../img/sudoku4.jpeg"};
+    if (argc > 1)
+        paths.assign(argv + 1, argv + argc);
+
+    for (std::string path : paths)
+    {
+        cv::Mat bgr = cv::imread(path);
+        if (bgr.empty())
+        {
+            std::cout << "error: " << path << " not read from file\n";
+            continue;
+        }
+        // same input size as SudokuProc::preProcessFrame
+        cv::resize(bgr, bgr, cv::Size(), 0.5, 0.5);
+
+        cv::Mat chain, chainGray, gray, fused;
+        double chainOtsu = 0, fusedOtsu = 0;
+        int64 t0 = cv::getTickCount();
+        for (int i = 0; i < ITERATIONS; i++)
+            chainOtsu = chainMask(bgr, &chainGray, &chain);
+        int64 t1 = cv::getTickCount();
+        for (int i = 0; i < ITERATIONS; i++)
+            fusedOtsu = getOtsuMask(bgr, &gray, &fused);
+        int64 t2 = cv::getTickCount();
+
+        double chainMs = (t1 - t0) * 1000. / cv::getTickFrequency() / ITERATIONS;
+        double fusedMs = (t2 - t1) * 1000. / cv::getTickFrequency() / ITERATIONS;
+        double diff = cv::countNonZero(chain != fused) * 100. / chain.total();
+
+        std::cout << path << " (" << bgr.cols << "x" << bgr.rows << ")\n"
+                  << "  chain: " << chainMs << " ms\n"
+                  << "  fused: " << fusedMs << " ms (" << chainMs / fusedMs << "x)\n"
+                  << "  otsu threshold: " << chainOtsu << " chain, " << fusedOtsu << " fused"
+                  << (chainOtsu == fusedOtsu ? "\n" : " (changed)\n")
+                  << "  mask pixels differing: " << diff << "%\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+/*=============================================================================
+#  Author:           Nicolas Queiroga - https://github.com/NicolasQueiroga/
+#  Email:            n.macielqueiroga@gmail.com
+#  FileName:         generate.cpp
+#  Description:      Generates graded puzzles in the 81-char format
+#  Version:          0.0.1
+=============================================================================*/
+
+#include <iostream>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include "generator.hpp"
+#include "solver.hpp"
+
+#define USAGE "usage: gen.exe [count > 0] [threads >= 0, 0 = all cores] [seed]\n"
+
+bool parseArg(const char *arg, long min, long max, long *value)
+{
+    char *end;
+    errno = 0;
+    long parsed = std::strtol(arg, &end, 10);
+    if (errno || end == arg || *end || parsed < min || parsed > max)
+        return false;
+    *value = parsed;
+    return true;
+}
+
+// puzzles go to stdout as "<81 chars> <difficulty> <clues> <nodes>",
+// throughput per difficulty tier goes to stderr
+int main(int argc, char **argv)
+{
+    long count = 1000, threads = 0, seed = std::random_device()();
+    if (argc > 4 || (argc > 1 && !parseArg(argv[1], 1, INT_MAX, &count)) ||
+        (argc > 2 && !parseArg(argv[2], 0, 1024, &threads)) || (argc > 3 && !parseArg(argv[3], 0, UINT_MAX, &seed)))
+    {
+        std::cerr << USAGE;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Puzzle> puzzles = generatePuzzles(count, seed, threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int tiers[DIFFICULTY_COUNT] = {0};
+    double tierSeconds[DIFFICULTY_COUNT] = {0};
+    for (const Puzzle &puzzle : puzzles)
+    {
+        std::cout << boardToString(puzzle.board) << " " << difficultyName(puzzle.difficulty) << " "
+                  << puzzle.clues << " " << puzzle.nodes << "\n";
+        tiers[puzzle.difficulty]++;
+        tierSeconds[puzzle.difficulty] += puzzle.seconds;
+    }
+
+    // per tier rate is puzzles per second of worker time spent on that tier,
+    // i.e. the single-core cost of one puzzle of that difficulty
+    std::cerr << count << " puzzles in " << seconds << " s wall (" << count / seconds << " puzzles/s, seed " << seed << ")\n";
+    for (int d = 0; d < DIFFICULTY_COUNT; d++)
+    {
+        std::cerr << "  " << difficultyName((Difficulty)d) << ": " << tiers[d];
+        if (tiers[d] > 0)
+            std::cerr << " (" << tiers[d] / tierSeconds[d] << " puzzles/s per core, "
+                      << tierSeconds[d] * 1000 / tiers[d] << " ms each)";
+        std::cerr << "\n";
+    }
+
+    return 0;
+}
@@ -7,9 +7,22 @@
 =============================================================================*/
 
 #include <iostream>
+#include <iomanip>
 #include "aux.hpp"
+#include "solver.hpp"
 #include <opencv2/ml.hpp>
 
+// Tuned on img/ at half resolution with the grid from getMaxAreaContour,
+// see the density table processFrame prints. Empty cells read 0.000 on
+// sudoku.png and sudoku4.jpeg; on sudoku3.jpeg two bottom-left cells get
+// 0.044 and 0.055 of grid line bleed and the shaded top-left cell 1.000.
+// Digits start at 0.240, 0.159 and 0.085 respectively. Empty cells above
+// 0.04 only hold ink that crosses the cell or misses its centre, which
+// getDigitBox rejects. A margin of d/6..d/10 reads the same boards; d/4
+// cuts into the digits.
+#define EMPTY_CELL_DENSITY 0.04
+#define CELL_MARGIN_DIVISOR 8
+
 class SudokuProc
 {
 protected:
@@ -17,25 +30,29 @@ protected:
     cv::Mat matClassificationInts;
     cv::Mat matTrainingImagesAsFlattenedFloats;
     cv::Mat bgr;
+    cv::Mat gray;
     cv::Mat dilated;
-    std::vector<std::vector<cv::Point>> contours;
-    std::vector<cv::Vec4i> hierarchy;
-
-    std::vector<std::vector<cv::Point>> numbers;
+    cv::Mat inkIntegral;
 
     std::vector<cv::Point> maxAreaContour;
-    double boxArea;
-    int board[9][9];
+    cv::Point gridOrigin;
+    double cellSize;
+    bool parallel;
+    int board[9][9]; // [row][col], 0 for empty cells, same layout as solver.hpp
+    double inkDensity[9][9];
+    cv::Rect digitBoxes[9][9];
 
 public:
     /**
      * @brief Construct a new Sudoku Proc object
      * 
      * @param path 
+     * @param parallel split the 81 cells across cv::parallel_for_ workers
      */
-    SudokuProc(std::string path)
+    SudokuProc(std::string path, bool parallel = false)
     {
         this->bgr = cv::imread(path);
+        this->parallel = parallel;
         this->kNearest = cv::ml::KNearest::create();
     }
     ~SudokuProc() {}
@@ -63,15 +80,9 @@ public:
 
     void preProcessFrame()
     {
-        cv::Mat gray, blur, thresh, kernel;
         cv::resize(this->bgr, this->bgr, cv::Size(), 0.5, 0.5);
-        cv::cvtColor(this->bgr, gray, cv::COLOR_BGR2GRAY);
-        // cv::GaussianBlur(gray, blur, cv::Size(1, 1), 3, 2);
-        cv::threshold(gray, thresh, 0, 255, cv::THRESH_OTSU | cv::THRESH_BINARY_INV);
-        kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(1, 1));
-        cv::morphologyEx(thresh, thresh, cv::MORPH_CLOSE, kernel);
-        cv::dilate(thresh, this->dilated, kernel);
-        getAllContours(this->dilated, &this->contours, &this->hierarchy);
+        cv::cvtColor(this->bgr, this->gray, cv::COLOR_BGR2GRAY);
+        cv::threshold(this->gray, this->dilated, 0, 255, cv::THRESH_OTSU | cv::THRESH_BINARY_INV);
         this->maxAreaContour = getMaxAreaContour(this->dilated);
     }
 
@@ -90,100 +101,188 @@ public:
                 ymin = p.y;
         }
 
-        double d = (xmax - xmin) / 9;
+        double d = (xmax - xmin) / 9.0;
         double center = d / 2;
 
-        this->boxArea = d * d;
+        this->gridOrigin = cv::Point(xmin, ymin);
+        this->cellSize = d;
 
-        // Mark all numbers
-        std::vector<cv::Point> numberCenters;
-        for (long unsigned int i = 0; i < this->contours.size(); i++)
-        {
-            double contourArea = cv::contourArea(contours[i]);
-            cv::Point center = getContourCenter(contours[i]);
-            if ((contourArea < (2 * this->boxArea / 3)) && (this->hierarchy[i][3] == -1) && ((center.x >= d/2) && (center.y >= d/2)))
-            {
-                this->numbers.push_back(contours[i]);
-                numberCenters.push_back(center);
-            }
-        }
-        cv::drawContours(this->bgr, numbers, -1, cv::Scalar(255, 0, 255), 2); // number contours
-        // std::sort(numbers.begin(), numbers.end(), this->sortByBoundingRectXPosition);
-        for (cv::Point p : numberCenters)
-            cv::drawMarker(this->bgr, p, cv::Scalar(193, 0, 255));
-        // ---
+        // Ink occupancy of any cell region is O(1) from the integral image
+        cv::integral(this->dilated, this->inkIntegral, CV_32S);
+
+        // Read every cell, one stripe per board row when running in parallel
+        cv::Range cells(0, 81);
+        int64 start = cv::getTickCount();
+        if (this->parallel)
+            cv::parallel_for_(cells, [this](const cv::Range &range) { this->processCells(range); }, 9);
+        else
+            this->processCells(cells);
+        double ms = (cv::getTickCount() - start) * 1000. / cv::getTickFrequency();
+        std::cout << "cells read in " << ms << " ms (" << (this->parallel ? "parallel" : "serial") << ")\n";
 
-        // Mark all free spaces
-        unsigned int count = numbers.size() - 1;
+        // Mark all free spaces and read numbers in board order
         for (int i = 0; i < 9; i++)
             for (int j = 0; j < 9; j++)
-            {
-                cv::Mat copy = this->bgr.clone();
-                cv::Rect box(j * d + xmin, i * d + ymin, d, d);
-                cv::Mat cropped = copy(box);
-                cv::rectangle(copy, box, cv::Scalar(0, 255, 255), 2);
-
-                bool contains = 1;
-                for (cv::Point p : numberCenters)
-                    contains = contains && !p.inside(box);
-                if (contains)
-                {
+                if (this->board[i][j] == 0)
                     cv::drawMarker(this->bgr, cv::Point(xmin + center + j * d, ymin + center + i * d), cv::Scalar(255, 255, 0));
-                    this->board[j][i] = 0;
-                }
                 else
                 {
-                    int detected = this->getNumbers(numbers[count]);
-                    this->board[j][i] = detected;
-                    count--;
+                    cv::rectangle(this->bgr, this->digitBoxes[i][j], cv::Scalar(255, 0, 123));
+                    std::cout << "info read = " << char(this->board[i][j] + '0') << "\n";
                 }
-                // cv::imshow("sqrs", copy);
-                // cv::waitKey(0);
-            }
         // ---
 
         std::cout << "\n\n";
         for (int i = 0; i < 9; i++)
         {
             for (int j = 0; j < 9; j++)
-                std::cout << " " << this->board[j][i];
+                std::cout << " " << this->board[i][j];
+            std::cout << "\n";
+        }
+
+        // Core ink density per cell, to check EMPTY_CELL_DENSITY on new images
+        std::cout << "\n" << std::fixed << std::setprecision(3);
+        for (int i = 0; i < 9; i++)
+        {
+            for (int j = 0; j < 9; j++)
+                std::cout << " " << this->inkDensity[i][j];
             std::cout << "\n";
         }
 
+        this->solve();
+
         cv::imshow("dilated", this->dilated);
         cv::imshow("BGR", this->bgr);
         cv::waitKey(0);
     }
 
-    int getNumbers(std::vector<cv::Point> number)
+    /**
+     * @brief Print the board read from the image in the 81-char format and
+     * the solution the solver finds for it.
+     */
+    void solve()
     {
-        std::string strFinalString;
+        std::cout << "\n" << boardToString(this->board) << "\n";
 
-        cv::Rect numberBox = cv::boundingRect(number);
-        cv::rectangle(this->bgr, numberBox, cv::Scalar(255, 0, 123));
-        cv::Mat ROI = this->dilated(numberBox);
+        int solution[9][9];
+        int solutions = countSolutions(this->board, 2, solution);
+        if (solutions == 0)
+        {
+            std::cout << "no solution, the board above was misread\n";
+            return;
+        }
+        if (solutions > 1)
+            std::cout << "more than one solution, showing the first\n";
 
-        cv::Mat ROIResized;
-        cv::resize(ROI, ROIResized, cv::Size(20, 30));
+        for (int i = 0; i < 9; i++)
+        {
+            for (int j = 0; j < 9; j++)
+                std::cout << " " << solution[i][j];
+            std::cout << "\n";
+        }
+    }
 
-        cv::Mat ROIFloat;
-        ROIResized.convertTo(ROIFloat, CV_32FC1);
+    /**
+     * @brief Classify the cells [range.start, range.end) in row-major order.
+     * Only writes the board, inkDensity and digitBoxes entries of its own
+     * cells, so disjoint ranges can run concurrently. Scratch buffers belong to the
+     * worker thread and are reused across every stripe and frame it runs.
+     *
+     * @param range
+     */
+    void processCells(const cv::Range &range)
+    {
+        static thread_local cv::Mat labels, stats, centroids;
+        static thread_local cv::Mat ROIResized, ROIFloat, CurrentChar;
+
+        for (int k = range.start; k < range.end; k++)
+        {
+            int i = k / 9, j = k % 9;
+            double d = this->cellSize;
+            cv::Rect box(j * d + this->gridOrigin.x, i * d + this->gridOrigin.y, d, d);
+            cv::Rect numberBox;
+            this->inkDensity[i][j] = this->getCellDensity(box);
+            if (this->inkDensity[i][j] >= EMPTY_CELL_DENSITY)
+                numberBox = this->getDigitBox(box, &labels, &stats, &centroids);
+
+            this->digitBoxes[i][j] = numberBox;
+            if (numberBox.empty())
+                this->board[i][j] = 0;
+            else
+                this->board[i][j] = this->getNumbers(numberBox, &ROIResized, &ROIFloat, &CurrentChar);
+        }
+    }
+
+    double getCellDensity(cv::Rect box)
+    {
+        // Only the central half of the cell is sampled to keep grid lines out
+        cv::Rect core(box.x + box.width / 4, box.y + box.height / 4, box.width / 2, box.height / 2);
+        return getRegionDensity(this->inkIntegral, core);
+    }
+
+    /**
+     * @brief Bounding box of the digit blob in a cell, empty if there is none.
+     * Picks the largest connected component that overlaps the central half of
+     * the cell, ignoring grid line fragments that cross the whole cell and
+     * speckle that stays near the border, so the crop matches the single
+     * contour bounding rects the kNN model was trained on.
+     *
+     * @param box
+     * @param labels
+     * @param stats
+     * @param centroids
+     * @return cv::Rect
+     */
+    cv::Rect getDigitBox(cv::Rect box, cv::Mat *labels, cv::Mat *stats, cv::Mat *centroids)
+    {
+        int margin = box.width / CELL_MARGIN_DIVISOR;
+        cv::Rect inner(box.x + margin, box.y + margin, box.width - 2 * margin, box.height - 2 * margin);
+        inner &= cv::Rect(0, 0, this->dilated.cols, this->dilated.rows);
+        cv::Rect core(inner.width / 4, inner.height / 4, inner.width - inner.width / 4 * 2, inner.height - inner.height / 4 * 2);
+
+        int n = cv::connectedComponentsWithStats(this->dilated(inner), *labels, *stats, *centroids, 8, CV_32S);
+
+        cv::Rect digit;
+        int maxArea = 0;
+        for (int k = 1; k < n; k++)
+        {
+            cv::Rect blob(stats->at<int>(k, cv::CC_STAT_LEFT), stats->at<int>(k, cv::CC_STAT_TOP),
+                          stats->at<int>(k, cv::CC_STAT_WIDTH), stats->at<int>(k, cv::CC_STAT_HEIGHT));
+            int area = stats->at<int>(k, cv::CC_STAT_AREA);
+            bool spansX = blob.x == 0 && blob.br().x == inner.width;
+            bool spansY = blob.y == 0 && blob.br().y == inner.height;
+            if (spansX || spansY || (blob & core).empty() || area <= maxArea)
+                continue;
+
+            digit = blob;
+            maxArea = area;
+        }
+
+        if (digit.empty())
+            return digit;
+        return digit + inner.tl();
+    }
+
+    int getNumbers(cv::Rect numberBox, cv::Mat *ROIResized, cv::Mat *ROIFloat, cv::Mat *CurrentChar)
+    {
+        cv::Mat ROI = this->dilated(numberBox);
+        cv::resize(ROI, *ROIResized, cv::Size(20, 30));
+        ROIResized->convertTo(*ROIFloat, CV_32FC1);
 
-        cv::Mat ROIFlattenedFloat = ROIFloat.reshape(1, 1);
-        cv::Mat CurrentChar(0, 0, CV_32F);
-        this->kNearest->findNearest(ROIFlattenedFloat, 1, CurrentChar);
+        cv::Mat ROIFlattenedFloat = ROIFloat->reshape(1, 1);
+        this->kNearest->findNearest(ROIFlattenedFloat, 1, *CurrentChar);
 
-        int fltCurrentChar = (int)CurrentChar.at<float>(0, 0);
-        strFinalString = strFinalString + char(int(fltCurrentChar));
-        std::cout << "info read = " << strFinalString << "\n";
+        int fltCurrentChar = (int)CurrentChar->at<float>(0, 0);
         return (fltCurrentChar - '0');
     }
 };
 
-std::string path = "../img/sudoku.png";
-int main(int, char **)
+// usage: run.exe [image] [parallel]
+int main(int argc, char **argv)
 {
-    SudokuProc sp = SudokuProc(path);
+    std::string path = argc > 1 ? argv[1] : "../img/sudoku.png";
+    bool parallel = argc > 2 && std::string(argv[2]) == "parallel";
+    SudokuProc sp = SudokuProc(path, parallel);
     sp.loadModel();
     sp.preProcessFrame();
     sp.processFrame();